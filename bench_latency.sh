@@ -0,0 +1,48 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# Mide la latencia de /health y /records de servicioA en dos revisiones
+# (por defecto la base y HEAD), levantando cada una con docker compose.
+#   ./bench_latency.sh [REF_ANTES] [REF_DESPUES]     N=500 ./bench_latency.sh
+BEFORE="${1:-$(git rev-list --max-parents=0 HEAD)}"
+AFTER="${2:-HEAD}"
+N="${N:-300}"
+URL="http://localhost:8080"
+RECORDS="/records?city=Madrid&from=2025-10-01&to=2025-11-30&limit=100"
+ROOT="$(git rev-parse --show-toplevel)"
+
+measure() {
+  for _ in $(seq 1 "$N"); do
+    curl -s -o /dev/null -w "%{time_total}\n" "$URL$1"
+  done | sort -n | awk '{ a[NR] = $1 * 1000 }
+    END { printf "p50=%.2fms p95=%.2fms p99=%.2fms\n",
+          a[int(NR * 0.50)], a[int(NR * 0.95)], a[int(NR * 0.99)] }'
+}
+
+run_ref() {
+  local ref="$1" dir
+  dir="$(mktemp -d)"
+  git worktree add -q --detach "$dir" "$ref"
+  pushd "$dir" >/dev/null
+
+  echo ">> $ref: levantando db + servicioa..." >&2
+  docker compose -p meteo_bench down -v >/dev/null 2>&1 || true
+  docker compose -p meteo_bench up -d --build db servicioa >/dev/null
+  until curl -fs "$URL/health" >/dev/null; do sleep 2; done
+  curl -s -F "file=@$ROOT/meteo.csv" "$URL/ingest/csv" >/dev/null
+
+  # Calentamiento (conexiones persistentes, caches de PostgreSQL)
+  N=50 measure "/health" >/dev/null
+  N=50 measure "$RECORDS" >/dev/null
+
+  printf "%-12s /health   %s\n" "$ref" "$(measure /health)"
+  printf "%-12s /records  %s\n" "$ref" "$(measure "$RECORDS")"
+
+  docker compose -p meteo_bench down -v >/dev/null
+  popd >/dev/null
+  git worktree remove --force "$dir"
+}
+
+echo ">> $N peticiones secuenciales por endpoint"
+run_ref "$BEFORE"
+run_ref "$AFTER"
@@ -12,3 +12,20 @@ CREATE TABLE IF NOT EXISTS public.weather_readings (
 CREATE INDEX IF NOT EXISTS idx_weather_city_date
   ON public.weather_readings(city, date);
 
+
+-- Resumen mensual por ciudad, mantenido por servicioA en cada ingesta.
+-- Solo suma filas realmente insertadas en weather_readings; se puede
+-- recalcular desde cero con `servicioa --rebuild-rollups`.
+-- servicioA la crea si falta y comprueba sus columnas al arrancar
+-- (rollup::ensure_schema): cambiar ambos a la vez.
+CREATE TABLE IF NOT EXISTS public.weather_monthly_rollup (
+  city TEXT NOT NULL,
+  month DATE NOT NULL,              -- primer dia del mes (YYYY-MM-01)
+  days INTEGER NOT NULL,
+  temp_min DOUBLE PRECISION NOT NULL,
+  temp_max DOUBLE PRECISION NOT NULL,
+  temp_avg_sum DOUBLE PRECISION NOT NULL,  -- suma de (temp_min + temp_max) / 2
+  precip_sum DOUBLE PRECISION NOT NULL,
+  cloud_sum BIGINT NOT NULL,
+  PRIMARY KEY (city, month)
+);
@@ -2,7 +2,6 @@
 
 #include <cstdlib>
 #include <iostream>
-#include <pqxx/pqxx>
 
 namespace {
 
@@ -28,17 +27,10 @@ std::string build_conninfo(const DBconfig &c) {
            " user=" + c.user + " password=" + c.pwd;
 }
 
-bool check_db(const std::string &conninfo) {
-    try {
-        pqxx::connection c(conninfo);
-        pqxx::work tx(c);
-        auto row = tx.exec1("SELECT 1");
-        int v = row[0].as<int>();
-        return v == 1;
-    } catch (const std::exception &e) {
-        std::cerr << "DB ERROR: " << e.what() << "\n";
-        return false;
-    }
+std::string bounded_conninfo(const std::string &conninfo) {
+    return conninfo + " connect_timeout=" + std::to_string(kConnectTimeoutS) +
+           " keepalives=1 keepalives_idle=5 keepalives_interval=2 keepalives_count=2"
+           " tcp_user_timeout=5000";
 }
 
 std::ostream &operator<<(std::ostream &os, const DBconfig &c) {
@@ -13,6 +13,13 @@ struct DBconfig {
 
 DBconfig build_config();
 std::string build_conninfo(const DBconfig &c);
-bool check_db(const std::string &conninfo);
+
+// Timeout de conexion (s) que aplica bounded_conninfo.
+constexpr int kConnectTimeoutS = 2;
+
+// conninfo para conexiones persistentes: connect_timeout, keepalives y
+// tcp_user_timeout, para que un socket medio abierto (failover, NAT) falle
+// en segundos en vez de bloquear el hilo hasta el timeout TCP del kernel.
+std::string bounded_conninfo(const std::string &conninfo);
 std::ostream &operator<<(std::ostream &os, const DBconfig &c);
 
@@ -0,0 +1,88 @@
+#include "db_health.h"
+
+#include "db_config.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+namespace {
+
+std::int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+} // namespace
+
+DbHealthMonitor::DbHealthMonitor(std::string conninfo,
+                                 std::chrono::milliseconds interval)
+    : conninfo_(probe_conninfo(conninfo)), interval_(interval) {}
+
+DbHealthMonitor::~DbHealthMonitor() { stop(); }
+
+std::string DbHealthMonitor::probe_conninfo(const std::string &conninfo) {
+    return bounded_conninfo(conninfo) + " options='-c statement_timeout=" +
+           std::to_string(kStatementTimeoutMs) + "'";
+}
+
+std::chrono::milliseconds DbHealthMonitor::max_age() const {
+    // Peor caso de una sonda sana: reconexion + SELECT al limite, mas el
+    // intervalo de espera hasta la siguiente
+    std::chrono::milliseconds slow_probe(kConnectTimeoutS * 1000 + kStatementTimeoutMs);
+    return std::max(interval_ * 3, slow_probe + interval_);
+}
+
+void DbHealthMonitor::start() {
+    ok_ = probe();
+    th_ = std::thread(&DbHealthMonitor::run, this);
+}
+
+void DbHealthMonitor::stop() {
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (th_.joinable()) {
+        th_.join();
+    }
+}
+
+bool DbHealthMonitor::ok() const {
+    if (!ok_.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    auto limit = std::chrono::duration_cast<std::chrono::nanoseconds>(max_age());
+    return now_ns() - last_ok_ns_.load(std::memory_order_relaxed) <= limit.count();
+}
+
+bool DbHealthMonitor::probe() {
+    try {
+        // Reutiliza la conexion; solo reconecta si no hay o se ha caido
+        if (!conn_ || !conn_->is_open()) {
+            conn_ = std::make_unique<pqxx::connection>(conninfo_);
+        }
+        pqxx::nontransaction tx(*conn_);
+        auto row = tx.exec1("SELECT 1");
+        if (row[0].as<int>() != 1) {
+            return false;
+        }
+        last_ok_ns_ = now_ns();
+        return true;
+    } catch (const std::exception &e) {
+        std::cerr << "DB ERROR: " << e.what() << "\n";
+        conn_.reset();
+        return false;
+    }
+}
+
+void DbHealthMonitor::run() {
+    std::unique_lock<std::mutex> lk(m_);
+    while (!cv_.wait_for(lk, interval_, [this] { return stopping_; })) {
+        lk.unlock();
+        ok_ = probe();
+        lk.lock();
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <pqxx/pqxx>
+#include <string>
+#include <thread>
+
+// Comprueba la BD en segundo plano sobre una conexion persistente, para que
+// /health responda con el ultimo estado conocido sin abrir conexiones.
+class DbHealthMonitor {
+public:
+    DbHealthMonitor(std::string conninfo, std::chrono::milliseconds interval);
+    ~DbHealthMonitor();
+
+    DbHealthMonitor(const DbHealthMonitor &) = delete;
+    DbHealthMonitor &operator=(const DbHealthMonitor &) = delete;
+
+    // Hace una primera comprobacion sincrona y lanza el hilo de refresco.
+    void start();
+    void stop();
+
+    // true si la ultima comprobacion fue bien y es reciente (menos de
+    // max_age()): una sonda colgada cuenta como BD caida.
+    bool ok() const;
+
+    // Antiguedad maxima de la ultima sonda correcta: 3 intervalos, pero nunca
+    // menos de lo que tarda una sonda lenta que reconecta, para no marcar
+    // caida una BD que responde con HEALTH_REFRESH_MS bajos.
+    std::chrono::milliseconds max_age() const;
+
+    // bounded_conninfo + statement_timeout para el SELECT de la sonda.
+    static std::string probe_conninfo(const std::string &conninfo);
+
+    static constexpr int kStatementTimeoutMs = 2000;
+
+private:
+    bool probe();
+    void run();
+
+    std::string conninfo_;
+    std::chrono::milliseconds interval_;
+    std::unique_ptr<pqxx::connection> conn_;
+    std::atomic<bool> ok_{false};
+    std::atomic<std::int64_t> last_ok_ns_{0}; // steady_clock, 0 = nunca
+    bool stopping_ = false;
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::thread th_;
+};
@@ -0,0 +1,44 @@
+#include "ingest.h"
+
+#include "rollup.h"
+
+namespace ingest {
+
+InsertResult insert_rows(pqxx::transaction_base &tx,
+                         const std::vector<ParsedRow> &rows) {
+    InsertResult out;
+
+    // INSERT + ON CONFLICT DO NOTHING + RETURNING 1
+    const char *sql =
+        "INSERT INTO weather_readings "
+        "(date, city, temp_max, temp_min, precip_mm, cloud_pct) "
+        "VALUES ($1,$2,$3,$4,$5,$6) "
+        "ON CONFLICT (city, date) DO NOTHING "
+        "RETURNING 1";
+
+    // Resumen mensual: solo cuentan las filas realmente insertadas
+    rollup::Accumulator acc;
+
+    for (const auto &r : rows) {
+        auto r2 = tx.exec_params(sql,
+                                 r.date_iso, // 'YYYY-MM-DD'
+                                 r.city,
+                                 r.temp_max,
+                                 r.temp_min,
+                                 r.precip_mm,
+                                 r.cloud_pct);
+        if (!r2.empty()) {
+            out.inserted++;
+            acc.add(r.city, r.date_iso, r.temp_max, r.temp_min, r.precip_mm,
+                    r.cloud_pct);
+        } else {
+            out.conflicts++;
+        }
+    }
+
+    // Misma transaccion: datos y resumen se confirman juntos
+    rollup::apply(tx, acc.rows());
+    return out;
+}
+
+} // namespace ingest
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <pqxx/pqxx>
+#include <string>
+#include <vector>
+
+namespace ingest {
+
+struct ParsedRow {
+    std::string date_iso;  // YYYY-MM-DD
+    std::string city;
+    double temp_max;
+    double temp_min;
+    double precip_mm;
+    int    cloud_pct;
+};
+
+struct InsertResult {
+    int inserted = 0;
+    int conflicts = 0; // conflicto UNIQUE (city,date) -> no inserta
+};
+
+// Inserta las filas y actualiza weather_monthly_rollup con las realmente
+// insertadas, todo dentro de `tx` (el commit lo hace quien llama).
+InsertResult insert_rows(pqxx::transaction_base &tx,
+                         const std::vector<ParsedRow> &rows);
+
+} // namespace ingest
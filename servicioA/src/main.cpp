@@ -1,7 +1,11 @@
 #define CPPHTTPLIB_NO_EXCEPTIONS // (Opcional, pero recomendado en entornos C++)
+#include <atomic>
 #include <chrono>
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <utility>
 #include <vector>
@@ -11,20 +15,15 @@
 #include <pqxx/pqxx>
 
 #include "db_config.h"
+#include "db_health.h"
+#include "ingest.h"
+#include "pg_pipeline.h"
+#include "rollup.h"
 #include "utils.h"
 
 using namespace std;
 using ordered_json = nlohmann::ordered_json;
 
-struct ParsedRow {
-    std::string date_iso;  // YYYY-MM-DD
-    std::string city;
-    double temp_max;
-    double temp_min;
-    double precip_mm;
-    int    cloud_pct;
-};
-
 int main(int argc, char** argv){
     DBconfig config = build_config();
 
@@ -34,12 +33,52 @@ int main(int argc, char** argv){
     // Muestra por pantalla todos los datos de la BD, solo para depurar
     string conninfo = build_conninfo(config);
     //cout << conninfo << endl;
-        
+
+    // Recalcula weather_monthly_rollup desde cero a partir de weather_readings
+    if (argc > 1 && string(argv[1]) == "--rebuild-rollups"){
+        try {
+            pqxx::connection c(conninfo);
+            rollup::ensure_schema(c);
+            long long n = rollup::rebuild(c);
+            std::cout << "Rollups mensuales recalculados: " << n << " filas\n";
+            return 0;
+        } catch (const std::exception& e) {
+            std::cerr << "DB ERROR: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
     if (argc > 1 && string(argv[1]) == "--server"){
+        // Estado de la BD refrescado en segundo plano (HEALTH_REFRESH_MS, por defecto 1000)
+        int refresh_ms = 1000;
+        if (const char* v = std::getenv("HEALTH_REFRESH_MS")) {
+            if (!utils::to_int(v, refresh_ms) || refresh_ms < 100) refresh_ms = 1000;
+        }
+        DbHealthMonitor db_health(conninfo, std::chrono::milliseconds(refresh_ms));
+        db_health.start();
+
+        // weather_monthly_rollup se crea aqui si la BD es anterior a la tabla.
+        // Si la BD no esta disponible al arrancar, se reintenta en la primera ingesta
+        std::atomic<bool> rollup_schema_ready{false};
+        std::mutex rollup_schema_mtx;
+        auto ensure_rollup_schema = [&](pqxx::connection& c) {
+            if (rollup_schema_ready) return;
+            std::lock_guard<std::mutex> lk(rollup_schema_mtx);
+            if (rollup_schema_ready) return;
+            rollup::ensure_schema(c);
+            rollup_schema_ready = true;
+        };
+        try {
+            pqxx::connection c(conninfo);
+            ensure_rollup_schema(c);
+        } catch (const std::exception& e) {
+            std::cerr << "DB ERROR: " << e.what() << "\n";
+        }
+
         httplib::Server svr;
         svr.Get("/health", [&](const httplib::Request&, httplib::Response& res) {
             nlohmann::json j;
-            if (check_db(conninfo)) {
+            if (db_health.ok()) {
                 j = { {"status", "DB OK"} };
                 res.status = 200;
             } else {
@@ -131,7 +170,7 @@ int main(int argc, char** argv){
             int rows_detected = 0;
             int rows_valid = 0;
             int rows_rejected = 0;
-            std::vector<ParsedRow> valid_rows;
+            std::vector<ingest::ParsedRow> valid_rows;
             valid_rows.reserve(256);
 
             while (std::getline(csv, line)) {
@@ -143,7 +182,7 @@ int main(int argc, char** argv){
 
                 for (auto& c : cols) c = utils::trim(c);
 
-                ParsedRow r;
+                ingest::ParsedRow r;
                 // Fecha
                 if (!utils::to_iso_date(cols[0], r.date_iso)) { rows_rejected++; continue; }
                 // Ciudad
@@ -179,27 +218,12 @@ int main(int argc, char** argv){
 
             try {
                 pqxx::connection c(conninfo);
+                ensure_rollup_schema(c);
                 pqxx::work tx(c);
 
-                // INSERT + ON CONFLICT DO NOTHING + RETURNING 1
-                const char* sql =
-                    "INSERT INTO weather_readings "
-                    "(date, city, temp_max, temp_min, precip_mm, cloud_pct) "
-                    "VALUES ($1,$2,$3,$4,$5,$6) "
-                    "ON CONFLICT (city, date) DO NOTHING "
-                    "RETURNING 1";
-
-                for (const auto& r : valid_rows) {
-                    auto r2 = tx.exec_params(sql,
-                                            r.date_iso,   // 'YYYY-MM-DD'
-                                            r.city,
-                                            r.temp_max,
-                                            r.temp_min,
-                                            r.precip_mm,
-                                            r.cloud_pct);
-                    if (!r2.empty()) rows_inserted++;
-                    else             conflicts++;   // conflicto UNIQUE (city,date) -> no inserta
-                }
+                auto ins = ingest::insert_rows(tx, valid_rows);
+                rows_inserted = ins.inserted;
+                conflicts = ins.conflicts;
 
                 tx.commit();
             } catch (const std::exception& e) {
@@ -240,7 +264,7 @@ int main(int argc, char** argv){
         svr.Get("/cities", [&](const httplib::Request&, httplib::Response& res) {
             try {
                 pqxx::connection c(conninfo);
-                pqxx::work tx(c);
+                pqxx::nontransaction tx(c);
                 pqxx::result r = tx.exec("SELECT DISTINCT city FROM weather_readings ORDER BY city ASC");
                 
                 vector<string> cities;
@@ -321,41 +345,48 @@ int main(int argc, char** argv){
 
             // -------- 2) Consulta a BD (count + page) --------
             try {
-                pqxx::connection c(conninfo);
-                pqxx::work tx(c);
+                // Conexion persistente por hilo del servidor (evita el handshake
+                // por peticion), con timeouts para no colgar el hilo si el socket
+                // queda medio abierto. count y página salen en una sola tanda en
+                // modo pipeline, con parámetros y sin BEGIN/COMMIT
+                thread_local std::unique_ptr<pgpipe::Connection> records_conn;
+                if (!records_conn) {
+                    records_conn = std::make_unique<pgpipe::Connection>(bounded_conninfo(conninfo));
+                }
+
+                const std::vector<std::string> where_params{city, from_iso, to_iso};
+                auto rs = records_conn->run({
+                    // total de filas para esa ciudad/intervalo
+                    {"SELECT COUNT(*) AS cnt "
+                     "FROM weather_readings "
+                     "WHERE city = $1 AND date >= $2 AND date <= $3",
+                     where_params},
+                    // datos paginados (ordenados por fecha asc)
+                    {"SELECT date, temp_max, temp_min, precip_mm, cloud_pct "
+                     "FROM weather_readings "
+                     "WHERE city = $1 AND date >= $2 AND date <= $3 "
+                     "ORDER BY date ASC "
+                     "LIMIT $4 OFFSET $5",
+                     {city, from_iso, to_iso, std::to_string(limit), std::to_string(offset)}}
+                });
+                const auto& rcount = rs[0];
+                const auto& rpage  = rs[1];
 
-                // total de filas para esa ciudad/intervalo
-                auto rcount = tx.exec_params(
-                    "SELECT COUNT(*) AS cnt "
-                    "FROM weather_readings "
-                    "WHERE city = $1 AND date >= $2 AND date <= $3",
-                    city, from_iso, to_iso
-                );
                 long long total = 0;
-                if (!rcount.empty()) {
-                    total = rcount[0]["cnt"].as<long long>(0);
+                if (rcount.rows() > 0) {
+                    total = std::stoll(rcount.get(0, "cnt"));
                 }
 
-                // datos paginados (ordenados por fecha asc)
-                auto rpage = tx.exec_params(
-                    "SELECT date, temp_max, temp_min, precip_mm, cloud_pct "
-                    "FROM weather_readings "
-                    "WHERE city = $1 AND date >= $2 AND date <= $3 "
-                    "ORDER BY date ASC "
-                    "LIMIT $4 OFFSET $5",
-                    city, from_iso, to_iso, limit, offset
-                );
-
                 // construir array de items
                 std::vector<ordered_json> items;
-                items.reserve(rpage.size());
-                for (const auto& row : rpage) {
+                items.reserve(rpage.rows());
+                for (int i = 0; i < rpage.rows(); ++i) {
                     ordered_json item{
-                        {"date",       row["date"].c_str()},
-                        {"temp_max", row["temp_max"].as<double>()},
-                        {"temp_min", row["temp_min"].as<double>()},
-                        {"precip_mm",  row["precip_mm"].as<double>()},
-                        {"cloud_pct",  row["cloud_pct"].as<int>()}
+                        {"date",       rpage.get(i, "date")},
+                        {"temp_max", std::stod(rpage.get(i, "temp_max"))},
+                        {"temp_min", std::stod(rpage.get(i, "temp_min"))},
+                        {"precip_mm",  std::stod(rpage.get(i, "precip_mm"))},
+                        {"cloud_pct",  std::stoi(rpage.get(i, "cloud_pct"))}
                     };
                     items.push_back(std::move(item));
                 }
@@ -389,8 +420,126 @@ int main(int argc, char** argv){
             }
         });
 
+        svr.Get("/rollups", [&](const httplib::Request& req, httplib::Response& res) {
+            using nlohmann::ordered_json;
+
+            // -------- 1) Validación de parámetros --------
+            auto city_it = req.params.find("city");
+            auto from_it = req.params.find("from");
+            auto to_it   = req.params.find("to");
+
+            if (city_it == req.params.end() || from_it == req.params.end() || to_it == req.params.end()) {
+                ordered_json jerr{
+                    {"error", "missing required query parameters"},
+                    {"required", {"city","from","to"}}
+                };
+                res.status = 400;
+                res.set_header("Access-Control-Allow-Origin", "*");
+                res.set_content(jerr.dump(), "application/json");
+                return;
+            }
+
+            std::string city = city_it->second;
+            std::string from_iso, to_iso;
+            if (!utils::to_iso_date(from_it->second, from_iso) || !utils::to_iso_date(to_it->second, to_iso)) {
+                ordered_json jerr{
+                    {"error", "invalid date format"},
+                    {"hint",  "use YYYY-MM-DD"}
+                };
+                res.status = 400;
+                res.set_header("Access-Control-Allow-Origin", "*");
+                res.set_content(jerr.dump(), "application/json");
+                return;
+            }
+            if (from_iso > to_iso) {
+                ordered_json jerr{{"error", "`from` must be <= `to`"}};
+                res.status = 400;
+                res.set_header("Access-Control-Allow-Origin", "*");
+                res.set_content(jerr.dump(), "application/json");
+                return;
+            }
+
+            // -------- 2) Consulta al resumen mensual --------
+            // Meses completos desde weather_monthly_rollup; los meses de los
+            // extremos que el rango corta se agregan desde weather_readings
+            try {
+                // Misma pauta que /records: conexion persistente por hilo con
+                // timeouts; si la guardada se cayo, un reintento con una nueva
+                thread_local std::unique_ptr<pqxx::connection> rollups_conn;
+                std::vector<rollup::MonthlyRollup> rows;
+                for (int attempt = 0; ; ++attempt) {
+                    bool reused = rollups_conn && rollups_conn->is_open();
+                    try {
+                        if (!reused) {
+                            rollups_conn = std::make_unique<pqxx::connection>(bounded_conninfo(conninfo));
+                        }
+                        pqxx::nontransaction tx(*rollups_conn);
+                        rows = rollup::range(tx, city, from_iso, to_iso);
+                        break;
+                    } catch (const pqxx::broken_connection&) {
+                        rollups_conn.reset();
+                        if (!reused || attempt > 0) throw;
+                    }
+                }
+
+                auto to_json = [](const rollup::MonthlyRollup& g) {
+                    if (g.days == 0) {
+                        return ordered_json{
+                            {"days",            0},
+                            {"temp_min",        nullptr},
+                            {"temp_max",        nullptr},
+                            {"temp_avg",        nullptr},
+                            {"precip_total_mm", 0.0},
+                            {"cloud_avg_pct",   nullptr}
+                        };
+                    }
+                    return ordered_json{
+                        {"days",            g.days},
+                        {"temp_min",        g.temp_min},
+                        {"temp_max",        g.temp_max},
+                        {"temp_avg",        g.temp_avg_sum / g.days},
+                        {"precip_total_mm", g.precip_sum},
+                        {"cloud_avg_pct",   static_cast<double>(g.cloud_sum) / g.days}
+                    };
+                };
+
+                std::vector<ordered_json> months;
+                months.reserve(rows.size());
+                for (const auto& g : rows) {
+                    ordered_json item{
+                        {"month",   g.month},
+                        {"partial", g.partial}
+                    };
+                    item.update(to_json(g));
+                    months.push_back(std::move(item));
+                }
+
+                ordered_json jout{
+                    {"city",    city},
+                    {"from",    from_iso},
+                    {"to",      to_iso},
+                    {"summary", to_json(rollup::combine(rows))},
+                    {"months",  months}
+                };
+
+                res.status = 200;
+                res.set_header("Access-Control-Allow-Origin", "*");
+                res.set_content(jout.dump(), "application/json");
+
+            } catch (const std::exception& e) {
+                ordered_json jerr{
+                    {"error", "database unavailable"},
+                    {"details", e.what()}
+                };
+                res.status = 503;
+                res.set_header("Access-Control-Allow-Origin", "*");
+                res.set_content(jerr.dump(), "application/json");
+            }
+        });
+
         std::cout << "HTTP server on :8080\n";
         svr.listen("0.0.0.0", 8080);
+        db_health.stop();
         return 0;
     }
 
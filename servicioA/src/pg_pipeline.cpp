@@ -0,0 +1,105 @@
+#include "pg_pipeline.h"
+
+#include <utility>
+
+namespace pgpipe {
+
+const char *Result::get(int row, const char *col) const {
+    int c = PQfnumber(res_.get(), col);
+    if (c < 0) {
+        throw std::runtime_error(std::string("unknown column: ") + col);
+    }
+    return PQgetvalue(res_.get(), row, c);
+}
+
+Connection::Connection(std::string conninfo)
+    : conninfo_(std::move(conninfo)), conn_(nullptr, &PQfinish) {}
+
+void Connection::fail(const std::string &what) {
+    std::string msg = what;
+    if (conn_) {
+        msg += ": ";
+        msg += PQerrorMessage(conn_.get());
+    }
+    // Se descarta la conexion; la siguiente llamada reconecta
+    conn_.reset();
+    throw broken_connection(msg);
+}
+
+void Connection::ensure() {
+    if (conn_ && PQstatus(conn_.get()) == CONNECTION_OK) {
+        return;
+    }
+    conn_.reset(PQconnectdb(conninfo_.c_str()));
+    if (!conn_ || PQstatus(conn_.get()) != CONNECTION_OK) {
+        fail("connection failed");
+    }
+}
+
+std::vector<Result> Connection::run(const std::vector<Query> &queries) {
+    bool reused = conn_ && PQstatus(conn_.get()) == CONNECTION_OK;
+    try {
+        return run_once(queries);
+    } catch (const broken_connection &) {
+        // La conexion guardada pudo caerse (reinicio de la BD): un reintento
+        if (!reused) throw;
+        return run_once(queries);
+    }
+}
+
+std::vector<Result> Connection::run_once(const std::vector<Query> &queries) {
+    ensure();
+    PGconn *c = conn_.get();
+
+    if (PQenterPipelineMode(c) != 1) {
+        fail("cannot enter pipeline mode");
+    }
+    for (const auto &q : queries) {
+        std::vector<const char *> values;
+        values.reserve(q.params.size());
+        for (const auto &p : q.params) {
+            values.push_back(p.c_str());
+        }
+        if (!PQsendQueryParams(c, q.sql.c_str(), static_cast<int>(values.size()),
+                               nullptr, values.data(), nullptr, nullptr, 0)) {
+            fail("send failed");
+        }
+    }
+    // Un solo sync: flush de toda la tanda y fin de la transaccion implicita
+    if (!PQpipelineSync(c)) {
+        fail("pipeline sync failed");
+    }
+
+    std::vector<Result> out;
+    out.reserve(queries.size());
+    std::string error;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        Result r(PQgetResult(c));
+        if (!r) {
+            fail("connection lost");
+        }
+        // Tras un error, las consultas siguientes llegan como PIPELINE_ABORTED
+        if (error.empty() && r.status() != PGRES_TUPLES_OK &&
+            r.status() != PGRES_COMMAND_OK) {
+            error = r.error_message();
+            if (error.empty()) error = "query failed";
+        }
+        out.push_back(std::move(r));
+        // NULL que cierra los resultados de esta consulta
+        while (PGresult *extra = PQgetResult(c)) {
+            PQclear(extra);
+        }
+    }
+    Result sync(PQgetResult(c));
+    if (!sync || sync.status() != PGRES_PIPELINE_SYNC) {
+        fail("pipeline sync not received");
+    }
+    PQexitPipelineMode(c);
+
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+    return out;
+}
+
+} // namespace pgpipe
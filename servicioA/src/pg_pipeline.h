@@ -0,0 +1,57 @@
+#pragma once
+
+#include <libpq-fe.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Envio de varias consultas parametrizadas en modo pipeline de libpq (14+):
+// se mandan todas con un solo flush y se espera una vez por las respuestas.
+namespace pgpipe {
+
+// Conexion perdida o imposible de abrir (a diferencia de un error SQL).
+struct broken_connection : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+struct Query {
+    std::string sql;
+    std::vector<std::string> params; // $1, $2... en formato texto
+};
+
+class Result {
+public:
+    explicit Result(PGresult *r) : res_(r, &PQclear) {}
+
+    explicit operator bool() const { return res_ != nullptr; }
+    ExecStatusType status() const { return PQresultStatus(res_.get()); }
+    int rows() const { return PQntuples(res_.get()); }
+    const char *error_message() const { return PQresultErrorMessage(res_.get()); }
+    // Valor en texto de la columna `col` (nombre) de la fila `row`
+    const char *get(int row, const char *col) const;
+
+private:
+    std::unique_ptr<PGresult, decltype(&PQclear)> res_;
+};
+
+class Connection {
+public:
+    explicit Connection(std::string conninfo);
+
+    // Ejecuta `queries` en una sola tanda (misma transaccion implicita) y
+    // devuelve sus resultados en orden. Lanza broken_connection si la
+    // conexion falla (tras un reintento si venia reutilizada) y
+    // std::runtime_error si alguna consulta falla.
+    std::vector<Result> run(const std::vector<Query> &queries);
+
+private:
+    void ensure();
+    std::vector<Result> run_once(const std::vector<Query> &queries);
+    [[noreturn]] void fail(const std::string &what);
+
+    std::string conninfo_;
+    std::unique_ptr<PGconn, decltype(&PQfinish)> conn_;
+};
+
+} // namespace pgpipe
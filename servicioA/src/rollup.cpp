@@ -0,0 +1,219 @@
+#include "rollup.h"
+
+#include <algorithm>
+#include <iterator>
+#include <pqxx/pqxx>
+#include <stdexcept>
+
+namespace {
+
+// Columnas que leen/escriben apply, range y rebuild (nombre, tipo en
+// information_schema). Deben coincidir con db/init/01_schema.sql.
+const std::pair<const char *, const char *> kRollupColumns[] = {
+    {"city", "text"},
+    {"month", "date"},
+    {"days", "integer"},
+    {"temp_min", "double precision"},
+    {"temp_max", "double precision"},
+    {"temp_avg_sum", "double precision"},
+    {"precip_sum", "double precision"},
+    {"cloud_sum", "bigint"},
+};
+
+} // namespace
+
+namespace rollup {
+
+std::string month_of(const std::string &date_iso) {
+    return date_iso.substr(0, 7) + "-01";
+}
+
+void Accumulator::add(const std::string &city, const std::string &date_iso,
+                      double temp_max, double temp_min, double precip_mm,
+                      int cloud_pct) {
+    std::string month = month_of(date_iso);
+    auto [it, inserted] = groups_.try_emplace({city, month});
+    MonthlyRollup &g = it->second;
+    if (inserted) {
+        g.city = city;
+        g.month = month;
+        g.temp_min = temp_min;
+        g.temp_max = temp_max;
+    } else {
+        g.temp_min = std::min(g.temp_min, temp_min);
+        g.temp_max = std::max(g.temp_max, temp_max);
+    }
+    g.days++;
+    g.temp_avg_sum += (temp_min + temp_max) / 2.0;
+    g.precip_sum += precip_mm;
+    g.cloud_sum += cloud_pct;
+}
+
+std::vector<MonthlyRollup> Accumulator::rows() const {
+    std::vector<MonthlyRollup> out;
+    out.reserve(groups_.size());
+    for (const auto &kv : groups_) {
+        out.push_back(kv.second);
+    }
+    return out;
+}
+
+void ensure_schema(pqxx::connection &c) {
+    // db/init/01_schema.sql es la definicion de referencia (volumen nuevo);
+    // esto solo cubre BD anteriores a la tabla
+    pqxx::nontransaction tx(c);
+    tx.exec0(
+        "CREATE TABLE IF NOT EXISTS public.weather_monthly_rollup ("
+        "city TEXT NOT NULL, "
+        "month DATE NOT NULL, "
+        "days INTEGER NOT NULL, "
+        "temp_min DOUBLE PRECISION NOT NULL, "
+        "temp_max DOUBLE PRECISION NOT NULL, "
+        "temp_avg_sum DOUBLE PRECISION NOT NULL, "
+        "precip_sum DOUBLE PRECISION NOT NULL, "
+        "cloud_sum BIGINT NOT NULL, "
+        "PRIMARY KEY (city, month))");
+
+    // Si la tabla ya existia (init script o version anterior), comprobar que
+    // sus columnas son las que usa este codigo
+    auto r = tx.exec(
+        "SELECT column_name, data_type FROM information_schema.columns "
+        "WHERE table_schema = 'public' AND table_name = 'weather_monthly_rollup'");
+    std::map<std::string, std::string> actual;
+    for (const auto &row : r) {
+        actual[row["column_name"].c_str()] = row["data_type"].c_str();
+    }
+    std::string mismatch;
+    for (const auto &[name, type] : kRollupColumns) {
+        auto it = actual.find(name);
+        if (it == actual.end()) {
+            mismatch += std::string(" missing ") + name + ";";
+        } else if (it->second != type) {
+            mismatch += std::string(" ") + name + " is " + it->second + ", expected " + type + ";";
+        }
+    }
+    if (actual.size() != std::size(kRollupColumns)) {
+        mismatch += " unexpected column count " + std::to_string(actual.size()) + ";";
+    }
+    if (!mismatch.empty()) {
+        throw std::runtime_error("weather_monthly_rollup schema mismatch:" + mismatch);
+    }
+}
+
+void apply(pqxx::transaction_base &tx, const std::vector<MonthlyRollup> &rows) {
+    // Un upsert por (ciudad, mes): min/max se combinan, sumas y conteo se suman
+    const char *sql =
+        "INSERT INTO weather_monthly_rollup AS r "
+        "(city, month, days, temp_min, temp_max, temp_avg_sum, precip_sum, cloud_sum) "
+        "VALUES ($1,$2,$3,$4,$5,$6,$7,$8) "
+        "ON CONFLICT (city, month) DO UPDATE SET "
+        "days = r.days + EXCLUDED.days, "
+        "temp_min = LEAST(r.temp_min, EXCLUDED.temp_min), "
+        "temp_max = GREATEST(r.temp_max, EXCLUDED.temp_max), "
+        "temp_avg_sum = r.temp_avg_sum + EXCLUDED.temp_avg_sum, "
+        "precip_sum = r.precip_sum + EXCLUDED.precip_sum, "
+        "cloud_sum = r.cloud_sum + EXCLUDED.cloud_sum";
+
+    for (const auto &g : rows) {
+        tx.exec_params(sql, g.city, g.month, g.days, g.temp_min, g.temp_max,
+                       g.temp_avg_sum, g.precip_sum, g.cloud_sum);
+    }
+}
+
+std::vector<MonthlyRollup> range(pqxx::transaction_base &tx,
+                                 const std::string &city,
+                                 const std::string &from_iso,
+                                 const std::string &to_iso) {
+    // Solo los meses de `from` y `to` pueden quedar cortados; sus dias se
+    // leen con dos rangos acotados sobre idx_weather_city_date (UNION quita
+    // duplicados cuando ambos extremos caen en el mismo mes)
+    auto r = tx.exec_params(
+        "WITH b AS ("
+        "  SELECT f, t, fm, tm,"
+        "         (f = fm AND (fm + interval '1 month')::date <= t + 1) AS f_full,"
+        "         (tm >= f AND (tm + interval '1 month')::date = t + 1) AS t_full"
+        "  FROM (SELECT $2::date AS f, $3::date AS t,"
+        "               date_trunc('month', $2::date)::date AS fm,"
+        "               date_trunc('month', $3::date)::date AS tm) x"
+        "), edge_days AS ("
+        "  SELECT w.* FROM weather_readings w, b"
+        "  WHERE NOT b.f_full AND w.city = $1"
+        "    AND w.date >= b.f AND w.date <= LEAST(b.t, (b.fm + interval '1 month')::date - 1)"
+        "  UNION"
+        "  SELECT w.* FROM weather_readings w, b"
+        "  WHERE NOT b.t_full AND w.city = $1"
+        "    AND w.date >= GREATEST(b.f, b.tm) AND w.date <= b.t"
+        ") "
+        "SELECT r.month, r.days, r.temp_min, r.temp_max, r.temp_avg_sum,"
+        "       r.precip_sum, r.cloud_sum, false AS partial "
+        "FROM weather_monthly_rollup r, b "
+        "WHERE r.city = $1 AND r.month >= b.f"
+        "  AND (r.month + interval '1 month')::date <= b.t + 1 "
+        "UNION ALL "
+        "SELECT date_trunc('month', date)::date, COUNT(*)::int, MIN(temp_min),"
+        "       MAX(temp_max), SUM((temp_min + temp_max) / 2.0), SUM(precip_mm),"
+        "       SUM(cloud_pct)::bigint, true "
+        "FROM edge_days "
+        "GROUP BY 1 "
+        "ORDER BY 1",
+        city, from_iso, to_iso);
+
+    std::vector<MonthlyRollup> out;
+    out.reserve(r.size());
+    for (const auto &row : r) {
+        MonthlyRollup g;
+        g.city = city;
+        g.month = row["month"].c_str();
+        g.days = row["days"].as<int>();
+        g.temp_min = row["temp_min"].as<double>();
+        g.temp_max = row["temp_max"].as<double>();
+        g.temp_avg_sum = row["temp_avg_sum"].as<double>();
+        g.precip_sum = row["precip_sum"].as<double>();
+        g.cloud_sum = row["cloud_sum"].as<long long>();
+        g.partial = row["partial"].as<bool>();
+        out.push_back(std::move(g));
+    }
+    return out;
+}
+
+MonthlyRollup combine(const std::vector<MonthlyRollup> &rows) {
+    MonthlyRollup out;
+    for (const auto &g : rows) {
+        if (g.days == 0) continue;
+        if (out.days == 0) {
+            out.temp_min = g.temp_min;
+            out.temp_max = g.temp_max;
+        } else {
+            out.temp_min = std::min(out.temp_min, g.temp_min);
+            out.temp_max = std::max(out.temp_max, g.temp_max);
+        }
+        out.days += g.days;
+        out.temp_avg_sum += g.temp_avg_sum;
+        out.precip_sum += g.precip_sum;
+        out.cloud_sum += g.cloud_sum;
+        out.partial = out.partial || g.partial;
+    }
+    return out;
+}
+
+long long rebuild(pqxx::connection &c) {
+    pqxx::work tx(c);
+
+    // SHARE bloquea ingestas concurrentes mientras se recalcula, para que
+    // ningun insert quede fuera del resumen ni se cuente dos veces
+    tx.exec0("LOCK TABLE weather_readings IN SHARE MODE");
+    tx.exec0("DELETE FROM weather_monthly_rollup");
+    auto r = tx.exec0(
+        "INSERT INTO weather_monthly_rollup "
+        "(city, month, days, temp_min, temp_max, temp_avg_sum, precip_sum, cloud_sum) "
+        "SELECT city, date_trunc('month', date)::date, COUNT(*), "
+        "MIN(temp_min), MAX(temp_max), SUM((temp_min + temp_max) / 2.0), "
+        "SUM(precip_mm), SUM(cloud_pct) "
+        "FROM weather_readings "
+        "GROUP BY city, date_trunc('month', date)");
+
+    tx.commit();
+    return r.affected_rows();
+}
+
+} // namespace rollup
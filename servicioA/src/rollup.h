@@ -0,0 +1,64 @@
+#pragma once
+
+#include <map>
+#include <pqxx/pqxx>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rollup {
+
+// Resumen mensual de una ciudad (tabla weather_monthly_rollup).
+struct MonthlyRollup {
+    std::string city;
+    std::string month; // YYYY-MM-01
+    int days = 0;
+    double temp_min = 0.0;
+    double temp_max = 0.0;
+    double temp_avg_sum = 0.0;
+    double precip_sum = 0.0;
+    long long cloud_sum = 0;
+    bool partial = false; // mes no cubierto entero por el rango consultado
+};
+
+// "2025-10-15" -> "2025-10-01"
+std::string month_of(const std::string &date_iso);
+
+// Acumula en memoria las filas insertadas en una ingesta, agrupadas por
+// (ciudad, mes), para volcarlas despues con un upsert por grupo.
+class Accumulator {
+public:
+    void add(const std::string &city, const std::string &date_iso,
+             double temp_max, double temp_min, double precip_mm,
+             int cloud_pct);
+    std::vector<MonthlyRollup> rows() const;
+    bool empty() const { return groups_.empty(); }
+
+private:
+    std::map<std::pair<std::string, std::string>, MonthlyRollup> groups_;
+};
+
+// Crea weather_monthly_rollup si no existe (los scripts de db/init solo se
+// ejecutan con el volumen vacio) y comprueba que sus columnas son las que
+// usa este modulo; lanza std::runtime_error si no coinciden.
+void ensure_schema(pqxx::connection &c);
+
+// Suma los deltas a weather_monthly_rollup dentro de la transaccion dada.
+void apply(pqxx::transaction_base &tx, const std::vector<MonthlyRollup> &rows);
+
+// Resumen de [from, to] por mes: los meses completos salen del resumen y los
+// meses de los extremos que el rango corta se agregan desde weather_readings,
+// asi el resultado coincide con agregar las filas diarias del rango.
+std::vector<MonthlyRollup> range(pqxx::transaction_base &tx,
+                                 const std::string &city,
+                                 const std::string &from_iso,
+                                 const std::string &to_iso);
+
+// Combina varios resumenes en uno (days == 0 si no hay filas).
+MonthlyRollup combine(const std::vector<MonthlyRollup> &rows);
+
+// Recalcula weather_monthly_rollup desde weather_readings. Devuelve el
+// numero de filas de resumen generadas.
+long long rebuild(pqxx::connection &c);
+
+} // namespace rollup
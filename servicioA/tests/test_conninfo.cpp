@@ -12,3 +12,12 @@ TEST_CASE("build_conninfo genera cadena válida para pqxx") {
     CHECK(s.find("user=meteo") != std::string::npos);
     CHECK(s.find("password=meteo") != std::string::npos);
 }
+
+TEST_CASE("bounded_conninfo acota conexion y red") {
+    auto s = bounded_conninfo("host=db port=5432");
+    CHECK(s.find("host=db port=5432") == 0);
+    CHECK(s.find("connect_timeout=") != std::string::npos);
+    CHECK(s.find("keepalives=1") != std::string::npos);
+    CHECK(s.find("tcp_user_timeout=") != std::string::npos);
+    CHECK(s.find("statement_timeout") == std::string::npos);
+}
@@ -0,0 +1,48 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "../src/third_party/doctest.h"
+#include "../src/db_config.h"
+#include "../src/db_health.h"
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+using std::chrono::milliseconds;
+
+TEST_CASE("DbHealthMonitor marca la BD como caida si no puede conectar") {
+    // Puerto sin servidor: la conexion falla de inmediato
+    DbHealthMonitor mon("host=127.0.0.1 port=1 dbname=meteo user=meteo",
+                        milliseconds(50));
+    mon.start();
+    CHECK_FALSE(mon.ok());
+    mon.stop();
+    CHECK_FALSE(mon.ok());
+}
+
+TEST_CASE("max_age cubre una sonda lenta aunque el intervalo sea corto") {
+    milliseconds slow_probe(kConnectTimeoutS * 1000 + DbHealthMonitor::kStatementTimeoutMs);
+
+    DbHealthMonitor fast("host=db", milliseconds(100));
+    CHECK(fast.max_age() > slow_probe);
+
+    DbHealthMonitor slow("host=db", milliseconds(10000));
+    CHECK(slow.max_age() == milliseconds(30000));
+}
+
+// Requieren PostgreSQL (docker-compose.tests.yml define DB_HOST)
+TEST_CASE("DbHealthMonitor con BD: ok tras start y caida si la sonda envejece") {
+    if (std::getenv("DB_HOST") == nullptr) {
+        MESSAGE("DB_HOST no definido: se omite el test con BD");
+        return;
+    }
+    DbHealthMonitor mon(build_conninfo(build_config()), milliseconds(100));
+    mon.start();
+    CHECK(mon.ok());
+
+    // Sin hilo de refresco no hay sondas nuevas: pasado max_age() el ultimo
+    // resultado correcto deja de valer y se informa caida
+    mon.stop();
+    CHECK(mon.ok());
+    std::this_thread::sleep_for(mon.max_age() + milliseconds(200));
+    CHECK_FALSE(mon.ok());
+}
@@ -0,0 +1,36 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "../src/third_party/doctest.h"
+#include "../src/db_config.h"
+#include "../src/pg_pipeline.h"
+#include <cstdlib>
+#include <string>
+
+TEST_CASE("run lanza broken_connection si no puede conectar") {
+    // Puerto sin servidor: la conexion falla de inmediato
+    pgpipe::Connection c("host=127.0.0.1 port=1 dbname=meteo user=meteo connect_timeout=1");
+    CHECK_THROWS_AS(c.run({{"SELECT 1", {}}}), pgpipe::broken_connection);
+}
+
+// Requiere PostgreSQL (docker-compose.tests.yml define DB_HOST)
+TEST_CASE("run envia varias consultas parametrizadas en una tanda") {
+    if (std::getenv("DB_HOST") == nullptr) {
+        MESSAGE("DB_HOST no definido: se omite el test con BD");
+        return;
+    }
+    pgpipe::Connection c(build_conninfo(build_config()));
+
+    auto rs = c.run({
+        {"SELECT $1::int + 1 AS n", {"41"}},
+        {"SELECT i FROM generate_series(1, $1::int) AS i ORDER BY i", {"3"}},
+    });
+    REQUIRE(rs.size() == 2);
+    CHECK(std::string(rs[0].get(0, "n")) == "42");
+    CHECK(rs[1].rows() == 3);
+    CHECK(std::string(rs[1].get(2, "i")) == "3");
+
+    // Un error SQL aborta la tanda pero la conexion sigue siendo usable
+    CHECK_THROWS_AS(c.run({{"SELECT 1/0 AS x", {}}, {"SELECT 1 AS y", {}}}),
+                    std::runtime_error);
+    auto again = c.run({{"SELECT $1::text AS s", {"ok"}}});
+    CHECK(std::string(again[0].get(0, "s")) == "ok");
+}
@@ -0,0 +1,54 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "../src/third_party/doctest.h"
+#include "../src/rollup.h"
+#include <string>
+
+TEST_CASE("month_of devuelve el primer dia del mes") {
+    CHECK(rollup::month_of("2025-10-15") == "2025-10-01");
+    CHECK(rollup::month_of("2024-02-29") == "2024-02-01");
+}
+
+TEST_CASE("Accumulator agrupa por ciudad y mes") {
+    rollup::Accumulator acc;
+    CHECK(acc.empty());
+    acc.add("Madrid", "2025-10-15", 16.5, 8.1, 1.4, 80);
+    acc.add("Madrid", "2025-10-16", 17.0, 7.9, 0.0, 50);
+    acc.add("Madrid", "2025-11-01", 12.0, 4.0, 2.0, 20);
+    acc.add("Bilbao", "2025-10-15", 14.0, 9.0, 5.5, 100);
+
+    auto rows = acc.rows();
+    REQUIRE(rows.size() == 3);
+
+    // std::map ordena por (ciudad, mes)
+    CHECK(rows[0].city == "Bilbao");
+    CHECK(rows[1].city == "Madrid");
+    CHECK(rows[1].month == "2025-10-01");
+    CHECK(rows[1].days == 2);
+    CHECK(rows[1].temp_min == doctest::Approx(7.9));
+    CHECK(rows[1].temp_max == doctest::Approx(17.0));
+    CHECK(rows[1].temp_avg_sum == doctest::Approx((16.5 + 8.1) / 2 + (17.0 + 7.9) / 2));
+    CHECK(rows[1].precip_sum == doctest::Approx(1.4));
+    CHECK(rows[1].cloud_sum == 130);
+    CHECK(rows[2].month == "2025-11-01");
+    CHECK(rows[2].days == 1);
+}
+
+TEST_CASE("combine suma meses y combina min/max") {
+    rollup::MonthlyRollup oct;
+    oct.days = 2; oct.temp_min = 7.9; oct.temp_max = 17.0;
+    oct.temp_avg_sum = 24.75; oct.precip_sum = 1.4; oct.cloud_sum = 130;
+    rollup::MonthlyRollup nov;
+    nov.days = 1; nov.temp_min = 4.0; nov.temp_max = 12.0;
+    nov.temp_avg_sum = 8.0; nov.precip_sum = 2.0; nov.cloud_sum = 20; nov.partial = true;
+
+    auto all = rollup::combine({oct, nov});
+    CHECK(all.days == 3);
+    CHECK(all.temp_min == doctest::Approx(4.0));
+    CHECK(all.temp_max == doctest::Approx(17.0));
+    CHECK(all.temp_avg_sum == doctest::Approx(32.75));
+    CHECK(all.precip_sum == doctest::Approx(3.4));
+    CHECK(all.cloud_sum == 150);
+    CHECK(all.partial);
+
+    CHECK(rollup::combine({}).days == 0);
+}